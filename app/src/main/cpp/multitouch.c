@@ -0,0 +1,187 @@
+#include "multitouch.h"
+
+/*
+    0003 002f 00000000	EV_ABS       ABS_MT_SLOT          00000000
+    0003 0039 00000000	EV_ABS       ABS_MT_TRACKING_ID   00000000
+    0003 003a 00000400	EV_ABS       ABS_MT_PRESSURE      00000400
+    0003 0035 00003b32	EV_ABS       ABS_MT_POSITION_X    000036aa
+    0003 0036 00004416	EV_ABS       ABS_MT_POSITION_Y    00004554
+    0003 002f 00000001	EV_ABS       ABS_MT_SLOT          00000001
+    0003 0039 00000001	EV_ABS       ABS_MT_TRACKING_ID   00000001
+    0003 003a 00000400	EV_ABS       ABS_MT_PRESSURE      00000400
+    0003 0035 000044bb	EV_ABS       ABS_MT_POSITION_X    00004943
+    0003 0036 00003bbb	EV_ABS       ABS_MT_POSITION_Y    00003a7c
+    0000 0000 00000000	EV_SYN       SYN_REPORT           00000000
+ */
+int write_event_down(int *fd, __s32 x1, __s32 y1, __s32 x2, __s32 y2) {
+    struct input_event event;
+    int ret;
+
+    event.type = EV_ABS;
+    event.code = ABS_MT_SLOT;
+    event.value = 0x00;
+    WRITE(fd, event)
+    event.type = EV_ABS;
+    event.code = ABS_MT_TRACKING_ID;
+    event.value = 0x00;
+    WRITE(fd, event)
+
+    if (motionRange.ABS_MT_PRESSURE_TRACKING.maximum > 0) {
+        event.type = EV_ABS;
+        event.code = ABS_MT_PRESSURE;
+        event.value = motionRange.ABS_MT_PRESSURE_TRACKING.maximum;
+        WRITE(fd, event)
+    }
+
+    previousX1 = x1;
+    event.type = EV_ABS;
+    event.code = ABS_MT_POSITION_X;
+    event.value = x1;
+    WRITE(fd, event)
+    previousY1 = y1;
+    event.type = EV_ABS;
+    event.code = ABS_MT_POSITION_Y;
+    event.value = y1;
+    WRITE(fd, event)
+    event.type = EV_ABS;
+    event.code = ABS_MT_SLOT;
+    event.value = 0x01;
+    WRITE(fd, event)
+    event.type = EV_ABS;
+    event.code = ABS_MT_TRACKING_ID;
+    event.value = 0x01;
+    WRITE(fd, event)
+
+    if (motionRange.ABS_MT_PRESSURE_TRACKING.maximum > 0) {
+        event.type = EV_ABS;
+        event.code = ABS_MT_PRESSURE;
+        event.value = motionRange.ABS_MT_PRESSURE_TRACKING.maximum;
+        WRITE(fd, event)
+    }
+
+    if (previousX2 != x2) {
+        previousX2 = x2;
+        event.type = EV_ABS;
+        event.code = ABS_MT_POSITION_X;
+        event.value = x2;
+        WRITE(fd, event)
+    }
+    if (previousY2 != y2) {
+        previousY2 = y2;
+        event.type = EV_ABS;
+        event.code = ABS_MT_POSITION_Y;
+        event.value = y2;
+        WRITE(fd, event)
+    }
+    event.type = EV_SYN;
+    event.code = SYN_REPORT;
+    event.value = 0;
+    WRITE(fd, event)
+    return 0;
+}
+
+/*
+    0003 002f 00000000	EV_ABS       ABS_MT_SLOT          00000000
+    0003 0035 00003b21	EV_ABS       ABS_MT_POSITION_X    00003699
+    0003 002f 00000001	EV_ABS       ABS_MT_SLOT          00000001
+    0003 0035 000044cc	EV_ABS       ABS_MT_POSITION_X    00004954
+    0000 0000 00000000	EV_SYN       SYN_REPORT           00000000
+ */
+int write_event_move(int *fd, __s32 x1, __s32 y1, __s32 x2, __s32 y2) {
+    struct input_event event;
+    int ret;
+
+    event.type = EV_ABS;
+    event.code = ABS_MT_SLOT;
+    event.value = 0x00;
+    WRITE(fd, event)
+
+    if (previousX1 != x1) {
+        previousX1 = x1;
+        event.type = EV_ABS;
+        event.code = ABS_MT_POSITION_X;
+        event.value = x1;
+        WRITE(fd, event)
+    }
+    if (previousY1 != y1) {
+        previousY1 = y1;
+        event.type = EV_ABS;
+        event.code = ABS_MT_POSITION_Y;
+        event.value = y1;
+        WRITE(fd, event)
+    }
+    event.type = EV_ABS;
+    event.code = ABS_MT_SLOT;
+    event.value = 0x01;
+    WRITE(fd, event)
+
+    if (previousX2 != x2) {
+        previousX2 = x2;
+        event.type = EV_ABS;
+        event.code = ABS_MT_POSITION_X;
+        event.value = x2;
+        WRITE(fd, event)
+    }
+    if (previousY2 != y2) {
+        previousY2 = y2;
+        event.type = EV_ABS;
+        event.code = ABS_MT_POSITION_Y;
+        event.value = y2;
+        WRITE(fd, event)
+    }
+    event.type = EV_SYN;
+    event.code = SYN_REPORT;
+    event.value = 0;
+    WRITE(fd, event)
+    return 0;
+}
+
+/*
+    0003 002f 00000000	EV_ABS       ABS_MT_SLOT          00000000
+    0003 003a 00000000	EV_ABS       ABS_MT_PRESSURE      00000000
+    0003 0039 ffffffff	EV_ABS       ABS_MT_TRACKING_ID   ffffffff
+    0003 002f 00000001	EV_ABS       ABS_MT_SLOT          00000001
+    0003 003a 00000000	EV_ABS       ABS_MT_PRESSURE      00000000
+    0003 0039 ffffffff	EV_ABS       ABS_MT_TRACKING_ID   ffffffff
+    0000 0000 00000000	EV_SYN       SYN_REPORT           00000000
+*/
+int write_event_up(int *fd) {
+    struct input_event event;
+    int ret;
+
+    event.type = EV_ABS;
+    event.code = ABS_MT_SLOT;
+    event.value = 0x00;
+    WRITE(fd, event)
+
+    if (motionRange.ABS_MT_PRESSURE_TRACKING.maximum > 0) {
+        event.type = EV_ABS;
+        event.code = ABS_MT_PRESSURE;
+        event.value = motionRange.ABS_MT_PRESSURE_TRACKING.minimum;
+        WRITE(fd, event)
+    }
+    event.type = EV_ABS;
+    event.code = ABS_MT_TRACKING_ID;
+    event.value = -0x01;
+    WRITE(fd, event)
+    event.type = EV_ABS;
+    event.code = ABS_MT_SLOT;
+    event.value = 0x01;
+    WRITE(fd, event)
+
+    if (motionRange.ABS_MT_PRESSURE_TRACKING.maximum > 0) {
+        event.type = EV_ABS;
+        event.code = ABS_MT_PRESSURE;
+        event.value = motionRange.ABS_MT_PRESSURE_TRACKING.minimum;
+        WRITE(fd, event)
+    }
+    event.type = EV_ABS;
+    event.code = ABS_MT_TRACKING_ID;
+    event.value = -0x01;
+    WRITE(fd, event)
+    event.type = EV_SYN;
+    event.code = SYN_REPORT;
+    event.value = 0;
+    WRITE(fd, event)
+    return 0;
+}
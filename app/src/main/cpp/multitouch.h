@@ -0,0 +1,18 @@
+/*
+ * Two finger events on slots 0 and 1, shared by pinch and stress, implemented in multitouch.c.
+ */
+#ifndef PINCH_MULTITOUCH_H
+#define PINCH_MULTITOUCH_H
+
+#include "touch.h"
+
+//ABS_MT_SLOT, ABS_MT_POSITION_X and ABS_MT_POSITION_Y per finger plus SYN_REPORT
+#define MULTITOUCH_MOVE_EVENTS 7
+
+int write_event_down(int *fd, __s32 x1, __s32 y1, __s32 x2, __s32 y2);
+
+int write_event_move(int *fd, __s32 x1, __s32 y1, __s32 x2, __s32 y2);
+
+int write_event_up(int *fd);
+
+#endif //PINCH_MULTITOUCH_H
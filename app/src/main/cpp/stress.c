@@ -0,0 +1,394 @@
+#include "multitouch.h"
+#include <linux/uinput.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+//Ramp: every level plays the same number of gestures back to back, each level faster
+#define STRESS_START_RATE 10.0
+#define STRESS_MAX_RATE 2000.0
+#define STRESS_RATE_STEP 1.25
+#define STRESS_GESTURES_PER_LEVEL 50
+#define STRESS_FAILED_LEVELS 2
+//Down, this many moves and up, so every gesture is the same number of frames to read
+#define STRESS_MOVES_PER_GESTURE 10
+//95% of the lift frames have to reach the reader within this long of the kernel stamping them
+#define STRESS_BUDGET_MS 8.0
+#define STRESS_BUDGET_PERCENTILE 95
+#define STRESS_SETTLE_MS 500.0
+#define STRESS_UINPUT_MAX 4095
+
+//State of the reader thread, everything but running is guarded by lock
+struct consumer {
+    pthread_mutex_t lock;
+    atomic_int running;
+    int completed;
+    long synDropped;
+    double completedAt[STRESS_GESTURES_PER_LEVEL];
+    double latency[STRESS_GESTURES_PER_LEVEL];
+} consumer = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
+uint32_t randomState;
+
+void sleep_until(double when) {
+    double left = when - now_ms();
+    if (left > 0) {
+        usleep(left * 1000);
+    }
+}
+
+/*
+ * Creates a two slot virtual touchscreen so the load generator also runs on host Linux.
+ * The evdev node belonging to it is looked up by name for the reader thread.
+ */
+int create_uinput_device(int *fd) {
+    struct uinput_user_dev dev;
+    char name[UINPUT_MAX_NAME_SIZE];
+    int ret;
+
+    *fd = open("/dev/uinput", O_WRONLY);
+    if (*fd < 0) {
+        fprintf(stderr, "Could not open /dev/uinput: %s\n", strerror(errno));
+        return -1;
+    }
+
+    memset(&dev, 0, sizeof(dev));
+    snprintf(name, sizeof(name), "pinch-stress-%d", getpid());
+    strcpy(dev.name, name);
+    dev.id.bustype = BUS_VIRTUAL;
+    dev.absmax[ABS_MT_SLOT] = 1;
+    dev.absmax[ABS_MT_TRACKING_ID] = 0xffff;
+    dev.absmax[ABS_MT_POSITION_X] = STRESS_UINPUT_MAX;
+    dev.absmax[ABS_MT_POSITION_Y] = STRESS_UINPUT_MAX;
+    dev.absmax[ABS_MT_PRESSURE] = 0xff;
+
+    if (ioctl(*fd, UI_SET_EVBIT, EV_ABS) < 0
+        || ioctl(*fd, UI_SET_ABSBIT, ABS_MT_SLOT) < 0
+        || ioctl(*fd, UI_SET_ABSBIT, ABS_MT_TRACKING_ID) < 0
+        || ioctl(*fd, UI_SET_ABSBIT, ABS_MT_POSITION_X) < 0
+        || ioctl(*fd, UI_SET_ABSBIT, ABS_MT_POSITION_Y) < 0
+        || ioctl(*fd, UI_SET_ABSBIT, ABS_MT_PRESSURE) < 0
+        || ioctl(*fd, UI_SET_PROPBIT, INPUT_PROP_DIRECT) < 0) {
+        fprintf(stderr, "Could not configure uinput device: %s\n", strerror(errno));
+        close(*fd);
+        return -1;
+    }
+    ret = write(*fd, &dev, sizeof(dev));
+    if (ret < (int) sizeof(dev) || ioctl(*fd, UI_DEV_CREATE) < 0) {
+        fprintf(stderr, "Could not create uinput device: %s\n", strerror(errno));
+        close(*fd);
+        return -1;
+    }
+
+    memset(&motionRange, 0, sizeof(motionRange));
+    motionRange.ABS_MT_X_TRACKING.maximum = STRESS_UINPUT_MAX;
+    motionRange.ABS_MT_Y_TRACKING.maximum = STRESS_UINPUT_MAX;
+    motionRange.ABS_MT_PRESSURE_TRACKING.maximum = 0xff;
+
+    //The node shows up asynchronously, give udev/ueventd up to a second
+    for (int attempt = 0; attempt < 50; attempt++) {
+        for (int i = 0; i < 128; i++) {
+            char fullPath[512];
+            char found[UINPUT_MAX_NAME_SIZE] = "";
+            sprintf(fullPath, "/dev/input/event%d", i);
+            int probe = open(fullPath, O_RDONLY);
+            if (probe < 0) {
+                continue;
+            }
+            ioctl(probe, EVIOCGNAME(sizeof(found) - 1), found);
+            close(probe);
+            if (strcmp(found, name) == 0) {
+                strcpy(devicePath, fullPath);
+                return 0;
+            }
+        }
+        usleep(20000);
+    }
+    fprintf(stderr, "Could not find event node of %s\n", name);
+    ioctl(*fd, UI_DEV_DESTROY);
+    close(*fd);
+    return -1;
+}
+
+void destroy_uinput_device(int fd) {
+    ioctl(fd, UI_DEV_DESTROY);
+    close(fd);
+}
+
+/*
+ * Reads the device the way InputReader does, blocked in poll until events arrive. A
+ * gesture is complete once the frame lifting both fingers has been read. Its latency is
+ * the time from the kernel stamping that frame to the read, so a reader that falls behind
+ * shows up as late gestures and SYN_DROPPED, independent of how punctual the injector is.
+ */
+void *consume_events(void *unused) {
+    struct input_event events[64];
+    struct pollfd pfd = {.fd = verifyFd, .events = POLLIN};
+    ssize_t len;
+    size_t count;
+    int lifted = 0;
+    double now;
+
+    while (atomic_load(&consumer.running)) {
+        if (poll(&pfd, 1, 100) <= 0) {
+            continue;
+        }
+        while ((len = read(verifyFd, events, sizeof(events))) > 0) {
+            now = now_ms();
+            count = (size_t) len / sizeof(struct input_event);
+            pthread_mutex_lock(&consumer.lock);
+            for (size_t i = 0; i < count; i++) {
+                if (events[i].type == EV_ABS && events[i].code == ABS_MT_TRACKING_ID
+                    && events[i].value == -1) {
+                    lifted++;
+                } else if (events[i].type == EV_SYN && events[i].code == SYN_REPORT) {
+                    //write_event_up releases slot 0 and 1 in the same frame
+                    if (lifted >= 2 && consumer.completed < STRESS_GESTURES_PER_LEVEL) {
+                        consumer.latency[consumer.completed] = now
+                                - (events[i].input_event_sec * 1000.0
+                                   + events[i].input_event_usec / 1000.0);
+                        consumer.completedAt[consumer.completed++] = now;
+                    }
+                    lifted = 0;
+                } else if (events[i].type == EV_SYN && events[i].code == SYN_DROPPED) {
+                    consumer.synDropped++;
+                    lifted = 0;
+                }
+            }
+            pthread_mutex_unlock(&consumer.lock);
+        }
+    }
+    return unused;
+}
+
+//xorshift32, so a seed replays the same gestures with any libc
+uint32_t next_random() {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+int random_range(int min, int max) {
+    return min + (int) (next_random() % (uint32_t) (max - min + 1));
+}
+
+//Far enough apart that every move changes the position and reaches the reader
+void random_pinch(struct gesture *g) {
+    int from = random_range(5, 90);
+    int to;
+    do {
+        to = random_range(5, 90);
+    } while (abs(to - from) < 20);
+    pinch_trajectory(g, from, to, random_range(0, 90));
+}
+
+//A swipe with a second finger following at a fixed distance
+void random_swipe(struct gesture *g) {
+    int from_x = random_range(10, 80);
+    int from_y = random_range(10, 90);
+    int to_x, to_y;
+    do {
+        to_x = random_range(10, 80);
+        to_y = random_range(10, 90);
+    } while (abs(to_x - from_x) < 20 && abs(to_y - from_y) < 20);
+    swipe_trajectory(g, from_x, from_y, to_x, to_y);
+
+    __s32 spacing = (motionRange.ABS_MT_X_TRACKING.maximum
+                     - motionRange.ABS_MT_X_TRACKING.minimum) / 10;
+    g->startX2 = g->startX1 + spacing;
+    g->startY2 = g->startY1;
+    g->endX2 = g->endX1 + spacing;
+    g->endY2 = g->endY1;
+}
+
+/*
+ * Plays down, STRESS_MOVES_PER_GESTURE moves and up, each frame at its place on the
+ * schedule. Frames that are already late are written right away to catch up.
+ */
+int play_gesture(int *fd, struct gesture *g, double start, double frameInterval) {
+    int ret;
+    double alpha;
+
+    sleep_until(start);
+    ret = write_event_down(fd, g->startX1, g->startY1, g->startX2, g->startY2);
+    if (ret < 0) {
+        return -1;
+    }
+    for (int step = 1; step <= STRESS_MOVES_PER_GESTURE; step++) {
+        alpha = step / (STRESS_MOVES_PER_GESTURE + 1.0);
+        sleep_until(start + step * frameInterval);
+        ret = write_event_move(fd, lerp(g->startX1, g->endX1, alpha),
+                               lerp(g->startY1, g->endY1, alpha),
+                               lerp(g->startX2, g->endX2, alpha),
+                               lerp(g->startY2, g->endY2, alpha));
+        if (ret < 0) {
+            return -1;
+        }
+    }
+    sleep_until(start + (STRESS_MOVES_PER_GESTURE + 1) * frameInterval);
+    return write_event_up(fd);
+}
+
+int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char *argv[]) {
+    int fd;
+    char *endptr;
+    int uinput;
+    pthread_t reader;
+
+    if (argc < 2 || argc > 3 || (argc == 3 && strcmp(argv[2], "--uinput") != 0)) {
+        fprintf(stderr,
+                "Usage: %s seed [--uinput]\n\n\nseed: Any number, the same seed replays the same gestures\n--uinput: Create a virtual touchscreen instead of using the real one\n\n",
+                argv[0]);
+        return 1;
+    }
+
+    unsigned long seed = strtoul(argv[1], &endptr, 10);
+    if (*endptr != '\0') {
+        printf("Could not interpret parameter: 'seed'\n");
+        return 1;
+    }
+    //xorshift never leaves zero
+    randomState = (uint32_t) seed ? (uint32_t) seed : 1;
+    uinput = argc == 3;
+
+    if (uinput) {
+        if (create_uinput_device(&fd) < 0) {
+            return 1;
+        }
+    } else {
+        fd = find_input_device();
+        if (fd < 0) {
+            fprintf(stderr, "Could not open touch controller: %s\n", strerror(errno));
+            return 1;
+        } else if (!fd) {
+            printf("Could not find touch device\n");
+            return 1;
+        }
+    }
+
+    //Completion is judged by what a reader gets, so without one there is nothing to measure
+    if (open_verify_channel() < 0) {
+        return 1;
+    }
+    //Kernel timestamps on the same clock as now_ms()
+    int clockId = CLOCK_MONOTONIC;
+    if (ioctl(verifyFd, EVIOCSCLOCKID, &clockId) < 0) {
+        fprintf(stderr, "Could not switch the reader to CLOCK_MONOTONIC: %s\n", strerror(errno));
+        return 1;
+    }
+    atomic_store(&consumer.running, 1);
+    if (pthread_create(&reader, NULL, consume_events, NULL) != 0) {
+        fprintf(stderr, "Could not start reader thread\n");
+        return 1;
+    }
+
+    //Delivery latency decides a level, the injector's lag behind its schedule is only reported
+    printf("%10s %10s %10s %10s %10s %10s %8s %8s\n", "target/s", "actual/s", "deliv p50",
+           "deliv p95", "deliv max", "inj lag p95", "lost", "dropped");
+
+    double liftAt[STRESS_GESTURES_PER_LEVEL];
+    double lag[STRESS_GESTURES_PER_LEVEL];
+    double late[STRESS_GESTURES_PER_LEVEL];
+    double sustainedRate = 0;
+    int failedLevels = 0;
+    for (double rate = STRESS_START_RATE;
+         rate <= STRESS_MAX_RATE && failedLevels < STRESS_FAILED_LEVELS;
+         rate *= STRESS_RATE_STEP) {
+        double period = 1000.0 / rate;
+        double frameInterval = period / (STRESS_MOVES_PER_GESTURE + 2);
+        long droppedBefore;
+        int completed;
+
+        pthread_mutex_lock(&consumer.lock);
+        consumer.completed = 0;
+        droppedBefore = consumer.synDropped;
+        pthread_mutex_unlock(&consumer.lock);
+
+        double levelStart = now_ms();
+        for (int i = 0; i < STRESS_GESTURES_PER_LEVEL; i++) {
+            struct gesture g;
+            double start = levelStart + i * period;
+
+            if (next_random() & 1) {
+                random_pinch(&g);
+            } else {
+                random_swipe(&g);
+            }
+            liftAt[i] = start + (STRESS_MOVES_PER_GESTURE + 1) * frameInterval;
+            if (play_gesture(&fd, &g, start, frameInterval) < 0) {
+                return 1;
+            }
+            lag[i] = now_ms() - liftAt[i];
+        }
+
+        //Give the reader time to catch up with the last lifts
+        double deadline = now_ms() + STRESS_SETTLE_MS;
+        do {
+            pthread_mutex_lock(&consumer.lock);
+            completed = consumer.completed;
+            pthread_mutex_unlock(&consumer.lock);
+            if (completed < STRESS_GESTURES_PER_LEVEL) {
+                usleep(1000);
+            }
+        } while (completed < STRESS_GESTURES_PER_LEVEL && now_ms() < deadline);
+
+        pthread_mutex_lock(&consumer.lock);
+        completed = consumer.completed;
+        long dropped = consumer.synDropped - droppedBefore;
+        for (int i = 0; i < completed; i++) {
+            late[i] = consumer.latency[i];
+        }
+        double lastCompletion = completed > 0 ? consumer.completedAt[completed - 1] : levelStart;
+        pthread_mutex_unlock(&consumer.lock);
+        int lost = STRESS_GESTURES_PER_LEVEL - completed;
+
+        if (completed > 0) {
+            double actualRate = completed * 1000.0 / (lastCompletion - levelStart);
+            qsort(late, completed, sizeof(double), compare_doubles);
+            qsort(lag, STRESS_GESTURES_PER_LEVEL, sizeof(double), compare_doubles);
+            double p95 = late[(completed - 1) * STRESS_BUDGET_PERCENTILE / 100];
+            printf("%10.1f %10.1f %10.2f %10.2f %10.2f %10.2f %8d %8ld\n", rate, actualRate,
+                   late[(completed - 1) / 2], p95, late[completed - 1],
+                   lag[(STRESS_GESTURES_PER_LEVEL - 1) * STRESS_BUDGET_PERCENTILE / 100],
+                   lost, dropped);
+            if (lost == 0 && dropped == 0 && p95 <= STRESS_BUDGET_MS) {
+                sustainedRate = rate;
+                failedLevels = 0;
+            } else {
+                failedLevels++;
+            }
+        } else {
+            printf("%10.1f %10s %10s %10s %10s %10s %8d %8ld\n", rate, "-", "-", "-", "-", "-",
+                   lost, dropped);
+            failedLevels++;
+        }
+        fflush(stdout);
+    }
+
+    if (failedLevels < STRESS_FAILED_LEVELS) {
+        printf("Stopped at the cap of %.1f gestures/s, the limit may be higher than measured\n",
+               STRESS_MAX_RATE);
+    }
+    if (sustainedRate > 0) {
+        printf("Highest sustained rate: %.1f gestures/s\n", sustainedRate);
+    } else {
+        printf("No rate could be sustained\n");
+    }
+
+    atomic_store(&consumer.running, 0);
+    pthread_join(reader, NULL);
+    close(verifyFd);
+    if (uinput) {
+        destroy_uinput_device(fd);
+    } else {
+        close(fd);
+    }
+    return 0;
+}
@@ -1,108 +1,7 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <fcntl.h>
-#include <unistd.h>
-#include <errno.h>
-#include <limits.h>
-#include <dirent.h>
-#include <linux/input.h>
-#include <sys/types.h>
-#include <math.h>
-#include <time.h>
+#include "touch.h"
 
-#define WRITE(fd, event) \
-    ret = write(*fd, &event, sizeof(event)); \
-    if (ret < sizeof(event)) { \
-    fprintf(stderr, "Write event failed: %s\n", strerror(errno)); \
-    close(*fd); \
-    return -1; \
-    }
-
-struct motion_range {
-    struct input_absinfo ABS_MT_X_TRACKING;
-    struct input_absinfo ABS_MT_Y_TRACKING;
-    struct input_absinfo ABS_MT_PRESSURE_TRACKING;
-} motionRange;
-
-__s32 previousX1 = 0;
-__s32 previousY1 = 0;
-__s32 previousX2 = 0;
-__s32 previousY2 = 0;
-
-static int determine_touch_device(int *fd) {
-    uint8_t *bits = NULL;
-    ssize_t bits_size = 0;
-    motionRange.ABS_MT_X_TRACKING.maximum = 0;
-    motionRange.ABS_MT_Y_TRACKING.maximum = 0;
-    motionRange.ABS_MT_PRESSURE_TRACKING.maximum = 0;
-    int j, k;
-    volatile int res;
-    while (1) {
-        res = ioctl(*fd, EVIOCGBIT(EV_ABS, bits_size), bits);
-        if (res < bits_size) {
-            break;
-        }
-        bits_size = res + 16;
-        bits = realloc(bits, bits_size * 2);
-        if (bits == NULL) {
-            fprintf(stderr, "failed to allocate buffer of size %d\n", (int) bits_size);
-            *fd = 0;
-            return 0;
-        }
-    }
-    for (j = 0; j < res; j++) {
-        for (k = 0; k < 8; k++)
-            if (bits[j] & 1 << k) {
-                int index = j * 8 + k;
-                switch (index) {
-                    case 53: //X
-                        if (ioctl(*fd, EVIOCGABS(j * 8 + k), &(motionRange.ABS_MT_X_TRACKING)) !=
-                            0) {
-                            motionRange.ABS_MT_X_TRACKING.maximum = 0;
-                        }
-                        break;
-                    case 54: //Y
-                        if (ioctl(*fd, EVIOCGABS(j * 8 + k), &(motionRange.ABS_MT_Y_TRACKING)) !=
-                            0) {
-                            motionRange.ABS_MT_Y_TRACKING.maximum = 0;
-                        }
-                        break;
-                    case 58: //Pressure
-                        if (ioctl(*fd, EVIOCGABS(j * 8 + k),
-                                  &(motionRange.ABS_MT_PRESSURE_TRACKING)) != 0) {
-                            motionRange.ABS_MT_PRESSURE_TRACKING.maximum = 0;
-                        }
-                        break;
-                }
-            }
-    }
-    free(bits);
-    if (motionRange.ABS_MT_X_TRACKING.maximum > 0 && motionRange.ABS_MT_Y_TRACKING.maximum > 0) {
-        return 1;
-    } else {
-        *fd = 0;
-        return 0;
-    }
-}
-
-int find_input_device() {
-    int fd = 0;
-    for (int i = 0; i < 128; i++) {
-        char fullPath[512];
-        sprintf(fullPath, "/dev/input/event%d", i);
-        fd = open(fullPath, O_RDWR);
-        if (fd > 0 && determine_touch_device(&fd)) {
-            break;
-        }
-    }
-
-    return fd;
-}
-
-__s32 lerp(__s32 start, __s32 end, double alpha) {
-    return (end - start) * alpha + start;
-}
+//ABS_MT_POSITION_X, ABS_MT_POSITION_Y and SYN_REPORT
+#define SWIPE_MOVE_EVENTS 3
 
 int write_event_down(int *fd, __s32 x, __s32 y) {
     struct input_event event;
@@ -192,9 +91,9 @@ int main(int argc, char *argv[]) {
     char *endptr;
     int ret;
 
-    if (argc != 6) {
+    if (argc != 6 && !((argc == 7 || argc == 9) && strcmp(argv[6], "--verify") == 0)) {
         fprintf(stderr,
-                "Usage: %s startX startY endX endY duration\n\n\nstartX,startY,endX,endY: Relative in %% from center\nduration: How long pinching takes in milliseconds\n\n",
+                "Usage: %s startX startY endX endY duration [--verify [period cap]]\n\n\nstartX,startY,endX,endY: Relative in %% from center\nduration: How long pinching takes in milliseconds\n--verify: Pace the gesture against a probe reader and report delivery\nperiod,cap: Drain the probe every period ms and write at most cap events in between (default 16 32)\n\n",
                 argv[0]);
         return 1;
     }
@@ -238,46 +137,62 @@ int main(int argc, char *argv[]) {
         printf("From and To are the same!\n");
         return 1;
     }
+    double verifyPeriod = VERIFY_CONSUMER_PERIOD_MS;
+    long verifyCap = VERIFY_PRESSURE_EVENTS;
+    if (argc == 9) {
+        verifyPeriod = strtol(argv[7], &endptr, 10);
+        if (*endptr != '\0' || verifyPeriod <= 0) {
+            printf("Could not interpret parameter: 'period'\n");
+            return 1;
+        }
+        verifyCap = strtol(argv[8], &endptr, 10);
+        if (*endptr != '\0' || verifyCap <= 0) {
+            printf("Could not interpret parameter: 'cap'\n");
+            return 1;
+        }
+    }
+    if (argc > 6) {
+        if (open_verify_channel() < 0) {
+            return 1;
+        }
+        set_pacing_cap(verifyPeriod, verifyCap, SWIPE_MOVE_EVENTS);
+    }
 
-    __s32 rangeX = (motionRange.ABS_MT_X_TRACKING.maximum - motionRange.ABS_MT_X_TRACKING.minimum);
-    __s32 rangeY = (motionRange.ABS_MT_Y_TRACKING.maximum - motionRange.ABS_MT_Y_TRACKING.minimum);
-    __s32 startPointX = (rangeX * from_x / 100.0) + motionRange.ABS_MT_X_TRACKING.minimum;
-    __s32 startPointY = (rangeY * from_y / 100.0) + motionRange.ABS_MT_Y_TRACKING.minimum;
-    __s32 endPointX = (rangeX * to_x / 100.0) + motionRange.ABS_MT_X_TRACKING.minimum;
-    __s32 endPointY = (rangeX * to_y / 100.0) + motionRange.ABS_MT_X_TRACKING.minimum;
+    struct gesture g;
+    swipe_trajectory(&g, from_x, from_y, to_x, to_y);
 
-    ret = write_event_down(&fd, startPointX, startPointY);
+    ret = write_event_down(&fd, g.startX1, g.startY1);
     if (ret < 0) {
         return 1;
     }
+    pace_frame();
 
     if (duration > 400) {
-        clock_t down, end, when;
-        double elapsed, alpha;
-        down = clock();
-        end = ((duration * CLOCKS_PER_SEC) / 1000.0) + down;
-        when = clock();
-        while (when < end) {
-            elapsed = (double) (when - down) * 1000.0 / CLOCKS_PER_SEC;
-            alpha = elapsed / duration;
-            __s32 pointX = lerp(startPointX, endPointX, alpha);
-            __s32 pointY = lerp(startPointY, endPointY, alpha);
+        double down, when, alpha;
+        down = now_ms();
+        when = down;
+        while (when < down + duration) {
+            alpha = (when - down) / duration;
+            __s32 pointX = lerp(g.startX1, g.endX1, alpha);
+            __s32 pointY = lerp(g.startY1, g.endY1, alpha);
             ret = write_event_move(&fd, pointX, pointY);
             if (ret < 0) {
                 return 1;
             }
-            when = clock();
+            pace_frame();
+            when = now_ms();
         }
     } else {
         double alpha;
         for (int step = 1; step <= duration; step++) {
             alpha = step / duration;
-            __s32 pointX = lerp(startPointX, endPointX, alpha);
-            __s32 pointY = lerp(startPointY, endPointY, alpha);
+            __s32 pointX = lerp(g.startX1, g.endX1, alpha);
+            __s32 pointY = lerp(g.startY1, g.endY1, alpha);
             ret = write_event_move(&fd, pointX, pointY);
             if (ret < 0) {
                 return 1;
             }
+            pace_frame();
             usleep(1000);
         }
     }
@@ -288,5 +203,8 @@ int main(int argc, char *argv[]) {
     }
 
     close(fd);
+    if (verifyFd >= 0 && finish_verify_channel() < 0) {
+        return 2;
+    }
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,268 @@
+#include "touch.h"
+
+struct motion_range motionRange;
+
+struct delivery_stats deliveryStats;
+
+int verifyFd = -1;
+char devicePath[512];
+static double verifyPeriodMs = VERIFY_CONSUMER_PERIOD_MS;
+static long verifyCapEvents = VERIFY_PRESSURE_EVENTS;
+
+__s32 previousX1 = 0;
+__s32 previousY1 = 0;
+__s32 previousX2 = 0;
+__s32 previousY2 = 0;
+
+static int determine_touch_device(int *fd) {
+    uint8_t *bits = NULL;
+    ssize_t bits_size = 0;
+    motionRange.ABS_MT_X_TRACKING.maximum = 0;
+    motionRange.ABS_MT_Y_TRACKING.maximum = 0;
+    motionRange.ABS_MT_PRESSURE_TRACKING.maximum = 0;
+    int j, k;
+    volatile int res;
+    while (1) {
+        res = ioctl(*fd, EVIOCGBIT(EV_ABS, bits_size), bits);
+        if (res < bits_size) {
+            break;
+        }
+        bits_size = res + 16;
+        bits = realloc(bits, bits_size * 2);
+        if (bits == NULL) {
+            fprintf(stderr, "failed to allocate buffer of size %d\n", (int) bits_size);
+            *fd = 0;
+            return 0;
+        }
+    }
+    for (j = 0; j < res; j++) {
+        for (k = 0; k < 8; k++)
+            if (bits[j] & 1 << k) {
+                int index = j * 8 + k;
+                switch (index) {
+                    case 53: //X
+                        if (ioctl(*fd, EVIOCGABS(j * 8 + k), &(motionRange.ABS_MT_X_TRACKING)) !=
+                            0) {
+                            motionRange.ABS_MT_X_TRACKING.maximum = 0;
+                        }
+                        break;
+                    case 54: //Y
+                        if (ioctl(*fd, EVIOCGABS(j * 8 + k), &(motionRange.ABS_MT_Y_TRACKING)) !=
+                            0) {
+                            motionRange.ABS_MT_Y_TRACKING.maximum = 0;
+                        }
+                        break;
+                    case 58: //Pressure
+                        if (ioctl(*fd, EVIOCGABS(j * 8 + k),
+                                  &(motionRange.ABS_MT_PRESSURE_TRACKING)) != 0) {
+                            motionRange.ABS_MT_PRESSURE_TRACKING.maximum = 0;
+                        }
+                        break;
+                }
+            }
+    }
+    free(bits);
+    if (motionRange.ABS_MT_X_TRACKING.maximum > 0 && motionRange.ABS_MT_Y_TRACKING.maximum > 0) {
+        return 1;
+    } else {
+        *fd = 0;
+        return 0;
+    }
+}
+
+int find_input_device() {
+    int fd = 0;
+    for (int i = 0; i < 128; i++) {
+        char fullPath[512];
+        sprintf(fullPath, "/dev/input/event%d", i);
+        fd = open(fullPath, O_RDWR);
+        if (fd > 0 && determine_touch_device(&fd)) {
+            strcpy(devicePath, fullPath);
+            break;
+        }
+    }
+
+    return fd;
+}
+
+double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/*
+ * Opens a second, non-blocking reader on the touch device, the probe. InputFlinger's own
+ * buffer can not be observed, the probe only shows what piles up in an evdev client buffer
+ * for a consumer that reads once per period and whether the kernel had to flush it.
+ */
+int open_verify_channel() {
+    verifyFd = open(devicePath, O_RDONLY | O_NONBLOCK);
+    if (verifyFd < 0) {
+        fprintf(stderr, "Could not open read-back channel: %s\n", strerror(errno));
+        return -1;
+    }
+    deliveryStats.lastDrainMs = now_ms();
+    return 0;
+}
+
+/*
+ * The probe is drained every periodMs and at most capEvents may be written in between,
+ * a fixed limit chosen by the user and not measured. The first frames are already spaced
+ * so a full frame rate of frameEvents stays under it.
+ */
+void set_pacing_cap(double periodMs, long capEvents, long frameEvents) {
+    verifyPeriodMs = periodMs;
+    verifyCapEvents = capEvents;
+    deliveryStats.frameDelayUs = (long) (periodMs * 1000 * frameEvents / capEvents);
+    if (deliveryStats.frameDelayUs > VERIFY_MAX_DELAY_US) {
+        deliveryStats.frameDelayUs = VERIFY_MAX_DELAY_US;
+    }
+    deliveryStats.maxFrameDelayUs = deliveryStats.frameDelayUs;
+}
+
+/*
+ * Reads everything queued since the last drain and returns how many events were waiting.
+ * Sets dropped if the kernel reported SYN_DROPPED, i.e. it flushed a full buffer.
+ */
+static long drain_verify_channel(int *dropped) {
+    struct input_event events[64];
+    ssize_t len;
+    size_t count;
+    long backlog = 0;
+
+    while ((len = read(verifyFd, events, sizeof(events))) > 0) {
+        count = (size_t) len / sizeof(struct input_event);
+        backlog += count;
+        for (size_t i = 0; i < count; i++) {
+            if (events[i].type != EV_SYN) {
+                continue;
+            }
+            if (events[i].code == SYN_REPORT) {
+                deliveryStats.framesRead++;
+            } else if (events[i].code == SYN_DROPPED) {
+                deliveryStats.synDropped++;
+                *dropped = 1;
+            }
+        }
+    }
+    deliveryStats.eventsRead += backlog;
+    return backlog;
+}
+
+/*
+ * Called after every frame. Once the cap is used up the frame waits for the next drain,
+ * so the probe never holds more than the cap plus one frame. The delay between frames
+ * grows when that happens or the probe overflowed anyway, and shrinks while less than
+ * half of the cap is used, so the frames spread out over the period instead of stalling.
+ */
+void pace_frame() {
+    double now;
+    long backlog, written;
+    int dropped = 0, stalled = 0;
+
+    if (verifyFd < 0) {
+        return;
+    }
+    now = now_ms();
+    written = deliveryStats.eventsWritten - deliveryStats.drainEventsWritten;
+    if (written >= verifyCapEvents && now - deliveryStats.lastDrainMs < verifyPeriodMs) {
+        usleep((deliveryStats.lastDrainMs + verifyPeriodMs - now) * 1000);
+        deliveryStats.capStalls++;
+        stalled = 1;
+        now = now_ms();
+    }
+    if (now - deliveryStats.lastDrainMs >= verifyPeriodMs) {
+        backlog = drain_verify_channel(&dropped);
+        deliveryStats.lastDrainMs = now;
+        deliveryStats.drainEventsWritten = deliveryStats.eventsWritten;
+        if (backlog > deliveryStats.maxBacklog) {
+            deliveryStats.maxBacklog = backlog;
+        }
+
+        if (dropped) {
+            deliveryStats.frameDelayUs = deliveryStats.frameDelayUs > 0
+                                         ? deliveryStats.frameDelayUs * 2 : VERIFY_MIN_BACKOFF_US;
+        } else if (stalled) {
+            deliveryStats.frameDelayUs = deliveryStats.frameDelayUs > 0
+                                         ? deliveryStats.frameDelayUs * 3 / 2
+                                         : VERIFY_MIN_BACKOFF_US;
+        } else if (written < verifyCapEvents / 2) {
+            deliveryStats.frameDelayUs -= deliveryStats.frameDelayUs / 8;
+            if (deliveryStats.frameDelayUs < VERIFY_MIN_DELAY_US) {
+                deliveryStats.frameDelayUs = 0;
+            }
+        }
+        if (deliveryStats.frameDelayUs > VERIFY_MAX_DELAY_US) {
+            deliveryStats.frameDelayUs = VERIFY_MAX_DELAY_US;
+        }
+        if (deliveryStats.frameDelayUs > deliveryStats.maxFrameDelayUs) {
+            deliveryStats.maxFrameDelayUs = deliveryStats.frameDelayUs;
+        }
+    }
+    if (deliveryStats.frameDelayUs > 0) {
+        usleep(deliveryStats.frameDelayUs);
+    }
+}
+
+/*
+ * Reads the tail of the gesture, prints the delivery statistics and returns -1 if the
+ * probe overflowed. That means the cap was more than its buffer holds, not that the
+ * gesture was lost for InputFlinger.
+ */
+int finish_verify_channel() {
+    int dropped = 0;
+
+    drain_verify_channel(&dropped);
+    close(verifyFd);
+    verifyFd = -1;
+
+    printf("Delivery: %ld frames written, %ld read back, %ld events written, %ld read, "
+           "fixed cap %ld events per %.0fms hit %ld times, max backlog %ld events, "
+           "%ld SYN_DROPPED on the probe, max frame delay %ldus\n",
+           deliveryStats.framesWritten, deliveryStats.framesRead, deliveryStats.eventsWritten,
+           deliveryStats.eventsRead, verifyCapEvents, verifyPeriodMs, deliveryStats.capStalls,
+           deliveryStats.maxBacklog, deliveryStats.synDropped, deliveryStats.maxFrameDelayUs);
+    return deliveryStats.synDropped > 0 ? -1 : 0;
+}
+
+__s32 lerp(__s32 start, __s32 end, double alpha) {
+    return (end - start) * alpha + start;
+}
+
+/*
+ * Both fingers on a line through the center, moving apart or together.
+ * from,to: Relative in % from center, angle: Degree from 0° to 90°
+ */
+void pinch_trajectory(struct gesture *g, int from, int to, int angle) {
+    double xShift = cos(angle * (M_PI / 180));
+    double yShift = sin(angle * (M_PI / 180));
+
+    __s32 halfSizeX = (motionRange.ABS_MT_X_TRACKING.maximum
+                       - motionRange.ABS_MT_X_TRACKING.minimum) / 2;
+    __s32 halfSizeY = (motionRange.ABS_MT_Y_TRACKING.maximum
+                       - motionRange.ABS_MT_Y_TRACKING.minimum) / 2;
+    __s32 midpointX = halfSizeX + motionRange.ABS_MT_X_TRACKING.minimum;
+    __s32 midpointY = halfSizeY + motionRange.ABS_MT_Y_TRACKING.minimum;
+    g->startX1 = midpointX + (halfSizeX * (from / 100.0) * xShift);
+    g->startY1 = midpointY + (halfSizeY * (from / 100.0) * yShift);
+    g->startX2 = midpointX - (halfSizeX * (from / 100.0) * xShift);
+    g->startY2 = midpointY - (halfSizeY * (from / 100.0) * yShift);
+    g->endX1 = midpointX + (halfSizeX * (to / 100.0) * xShift);
+    g->endY1 = midpointY + (halfSizeY * (to / 100.0) * yShift);
+    g->endX2 = midpointX - (halfSizeX * (to / 100.0) * xShift);
+    g->endY2 = midpointY - (halfSizeY * (to / 100.0) * yShift);
+}
+
+/*
+ * A straight line for the first finger, the second one is left untouched.
+ * from_x,from_y,to_x,to_y: Relative in % of the screen
+ */
+void swipe_trajectory(struct gesture *g, int from_x, int from_y, int to_x, int to_y) {
+    __s32 rangeX = (motionRange.ABS_MT_X_TRACKING.maximum - motionRange.ABS_MT_X_TRACKING.minimum);
+    __s32 rangeY = (motionRange.ABS_MT_Y_TRACKING.maximum - motionRange.ABS_MT_Y_TRACKING.minimum);
+    g->startX1 = (rangeX * from_x / 100.0) + motionRange.ABS_MT_X_TRACKING.minimum;
+    g->startY1 = (rangeY * from_y / 100.0) + motionRange.ABS_MT_Y_TRACKING.minimum;
+    g->endX1 = (rangeX * to_x / 100.0) + motionRange.ABS_MT_X_TRACKING.minimum;
+    g->endY1 = (rangeY * to_y / 100.0) + motionRange.ABS_MT_Y_TRACKING.minimum;
+}
@@ -0,0 +1,101 @@
+/*
+ * Touch device discovery, read-back channel and trajectories shared by pinch, swipe and
+ * stress, implemented in touch.c.
+ */
+#ifndef PINCH_TOUCH_H
+#define PINCH_TOUCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <dirent.h>
+#include <linux/input.h>
+#include <sys/ioctl.h>
+#include <sys/types.h>
+#include <math.h>
+#include <time.h>
+
+#define WRITE(fd,event) \
+    ret = write(*fd, &event, sizeof(event)); \
+    if (ret < (int) sizeof(event)) { \
+    fprintf(stderr, "Write event failed: %s\n", strerror(errno)); \
+    close(*fd); \
+    return -1; \
+    } \
+    deliveryStats.eventsWritten++; \
+    if (event.type == EV_ABS && event.code != ABS_MT_SLOT) { \
+    deliveryStats.frameHasData = 1; \
+    } else if (event.type == EV_SYN && deliveryStats.frameHasData) { \
+    deliveryStats.frameHasData = 0; \
+    deliveryStats.framesWritten++; \
+    }
+
+struct motion_range {
+    struct input_absinfo ABS_MT_X_TRACKING;
+    struct input_absinfo ABS_MT_Y_TRACKING;
+    struct input_absinfo ABS_MT_PRESSURE_TRACKING;
+};
+
+//Frames only count when they change something, the input core filters empty ones
+struct delivery_stats {
+    int frameHasData;
+    long framesWritten;
+    long framesRead;
+    long eventsWritten;
+    long eventsRead;
+    long maxBacklog;
+    long capStalls;
+    long synDropped;
+    long frameDelayUs;
+    long maxFrameDelayUs;
+    double lastDrainMs;
+    long drainEventsWritten;
+};
+
+struct gesture {
+    __s32 startX1, startY1, startX2, startY2;
+    __s32 endX1, endY1, endX2, endY2;
+};
+
+extern struct motion_range motionRange;
+extern struct delivery_stats deliveryStats;
+//Read-back channel on the touch device, -1 while delivery verification is off
+extern int verifyFd;
+extern char devicePath[512];
+
+extern __s32 previousX1;
+extern __s32 previousY1;
+extern __s32 previousX2;
+extern __s32 previousY2;
+
+//Defaults for --verify, the cap is half of the smallest evdev buffer (64 events)
+#define VERIFY_CONSUMER_PERIOD_MS 16.0
+#define VERIFY_PRESSURE_EVENTS 32
+#define VERIFY_MIN_BACKOFF_US 500
+#define VERIFY_MIN_DELAY_US 50
+#define VERIFY_MAX_DELAY_US 16000
+
+int find_input_device();
+
+double now_ms();
+
+int open_verify_channel();
+
+void set_pacing_cap(double periodMs, long capEvents, long frameEvents);
+
+void pace_frame();
+
+int finish_verify_channel();
+
+__s32 lerp(__s32 start, __s32 end, double alpha);
+
+void pinch_trajectory(struct gesture *g, int from, int to, int angle);
+
+void swipe_trajectory(struct gesture *g, int from_x, int from_y, int to_x, int to_y);
+
+#endif //PINCH_TOUCH_H